@@ -0,0 +1,157 @@
+#!/usr/bin/env python
+"""
+Reference decoder for the States published by the ASaveStateActor in Publisher Mode.
+
+Can be run as a ROS node standing in for an external Mirror: it subscribes to the State topic,
+keeps a mirrored copy of the published Actors and acknowledges every Keyframe it receives.
+The layout decoded here is described in the README under "Wire Format".
+"""
+
+import base64
+import struct
+
+STATE_TOPIC = "/unreal_save_system/ue4_ros_state"
+ACK_TOPIC = "/unreal_save_system/ue4_ros_state_ack"
+
+SSF_TRANSFORM = 1 << 0
+SSF_PHYSICS = 1 << 1
+SSF_ACTOR_DATA = 1 << 2
+SSF_CLASS = 1 << 3
+
+# Matches MaxUnacknowledgedKeyframes of the ASaveStateActor.
+MAX_KEYFRAMES = 8
+
+
+class StateReader(object):
+    """Reads the little-endian FArchive layouts used by the publisher."""
+
+    def __init__(self, data):
+        self.data = data
+        self.offset = 0
+
+    def _unpack(self, fmt):
+        values = struct.unpack_from("<" + fmt, self.data, self.offset)
+        self.offset += struct.calcsize("<" + fmt)
+        return values
+
+    def uint8(self):
+        return self._unpack("B")[0]
+
+    def uint32(self):
+        return self._unpack("I")[0]
+
+    def int32(self):
+        return self._unpack("i")[0]
+
+    def floats(self, amount):
+        return self._unpack("%df" % amount)
+
+    def string(self):
+        # Positive lengths are ANSI, negative ones UTF-16, both including the null terminator.
+        length = self.int32()
+        if length == 0:
+            return ""
+        if length > 0:
+            raw = self.data[self.offset:self.offset + length]
+            self.offset += length
+            return raw[:-1].decode("latin-1")
+        raw = self.data[self.offset:self.offset - length * 2]
+        self.offset -= length * 2
+        return raw[:-2].decode("utf-16-le")
+
+    def byte_array(self):
+        length = self.int32()
+        raw = self.data[self.offset:self.offset + length]
+        self.offset += length
+        return raw
+
+
+def decode_state(payload):
+    """Decodes a Base64 payload into a dict holding the header, changed entries and removed actors."""
+    reader = StateReader(base64.b64decode(payload))
+    state = {
+        "is_keyframe": reader.uint8() != 0,
+        "sequence": reader.uint32(),
+        "base_sequence": reader.uint32(),
+        "world_name": reader.string(),
+        "entries": [],
+        "removed": [],
+    }
+
+    for _ in range(reader.int32()):
+        entry = {"level_name": reader.string(), "actor_name": reader.string()}
+        flags = reader.uint8()
+        if flags & SSF_CLASS:
+            entry["class_path"] = reader.string()
+        if flags & SSF_TRANSFORM:
+            entry["rotation"] = reader.floats(4)
+            entry["translation"] = reader.floats(3)
+            entry["scale"] = reader.floats(3)
+        if flags & SSF_PHYSICS:
+            entry["simulating_physics"] = reader.uint8() != 0
+            entry["linear_velocity"] = reader.floats(3)
+            entry["angular_velocity"] = reader.floats(3)
+        if flags & SSF_ACTOR_DATA:
+            entry["actor_data"] = reader.byte_array()
+        state["entries"].append(entry)
+
+    for _ in range(reader.int32()):
+        state["removed"].append((reader.string(), reader.string()))
+
+    return state
+
+
+class StateMirror(object):
+    """Rebuilds the published World from Keyframes and the Deltas encoded against them."""
+
+    def __init__(self):
+        self.keyframes = {}
+        self.actors = {}
+
+    def apply(self, state):
+        """Applies a decoded State, returns False if its Keyframe is unknown."""
+        if state["is_keyframe"]:
+            base = {}
+        elif state["base_sequence"] in self.keyframes:
+            base = self.keyframes[state["base_sequence"]]
+        else:
+            return False
+
+        actors = dict((key, dict(value)) for key, value in base.items())
+        for entry in state["entries"]:
+            key = (entry["level_name"], entry["actor_name"])
+            actors.setdefault(key, {}).update(entry)
+        for key in state["removed"]:
+            actors.pop(key, None)
+
+        if state["is_keyframe"]:
+            self.keyframes[state["sequence"]] = actors
+            for sequence in sorted(self.keyframes)[:-MAX_KEYFRAMES]:
+                del self.keyframes[sequence]
+        self.actors = actors
+        return True
+
+
+def main():
+    import rospy
+    from std_msgs.msg import String
+
+    rospy.init_node("unreal_state_mirror")
+    mirror = StateMirror()
+    ack_publisher = rospy.Publisher(ACK_TOPIC, String, queue_size=1)
+
+    def on_state(message):
+        state = decode_state(message.data)
+        if not mirror.apply(state):
+            rospy.logwarn("Delta %d against unknown Keyframe %d", state["sequence"], state["base_sequence"])
+            return
+        if state["is_keyframe"]:
+            ack_publisher.publish(String(data=str(state["sequence"])))
+        rospy.loginfo("State %d: %d Actors mirrored", state["sequence"], len(mirror.actors))
+
+    rospy.Subscriber(STATE_TOPIC, String, on_state)
+    rospy.spin()
+
+
+if __name__ == "__main__":
+    main()
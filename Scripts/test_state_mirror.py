@@ -0,0 +1,89 @@
+#!/usr/bin/env python
+"""
+Checks the reference decoder against the payloads in Fixtures, without needing ROS.
+
+The same payloads are compared against FStateSnapshot::EncodeKeyframe and EncodeDelta by the
+UStateSavePlugin.StateSnapshot.Encoding automation test, so a layout change on either side fails.
+Run with: python Scripts/test_state_mirror.py
+"""
+
+import os
+import unittest
+
+from state_mirror import StateMirror, decode_state
+
+FIXTURE_DIR = os.path.join(os.path.dirname(os.path.abspath(__file__)), "Fixtures")
+STATIC_MESH_ACTOR = "/Script/Engine.StaticMeshActor"
+
+
+def load_fixture(name):
+    with open(os.path.join(FIXTURE_DIR, name)) as fixture:
+        return fixture.read().strip()
+
+
+class StateMirrorTest(unittest.TestCase):
+
+    def test_decode_keyframe(self):
+        state = decode_state(load_fixture("state_keyframe.b64"))
+
+        self.assertTrue(state["is_keyframe"])
+        self.assertEqual(state["sequence"], 3)
+        self.assertEqual(state["base_sequence"], 3)
+        self.assertEqual(state["world_name"], "TestWorld")
+        self.assertEqual(state["removed"], [])
+        self.assertEqual(len(state["entries"]), 2)
+
+        cube = state["entries"][0]
+        self.assertEqual(cube["level_name"], "/Game/Maps/Test")
+        self.assertEqual(cube["actor_name"], "Cube_1")
+        self.assertEqual(cube["class_path"], STATIC_MESH_ACTOR)
+        self.assertEqual(cube["rotation"], (0.0, 0.0, 0.0, 1.0))
+        self.assertEqual(cube["translation"], (100.0, 200.0, 300.0))
+        self.assertEqual(cube["scale"], (1.0, 1.0, 1.0))
+        self.assertTrue(cube["simulating_physics"])
+        self.assertEqual(cube["linear_velocity"], (1.0, 2.0, 3.0))
+        self.assertEqual(cube["angular_velocity"], (0.0, 0.0, 90.0))
+        self.assertEqual(cube["actor_data"], bytes(bytearray([1, 2, 3, 4])))
+
+        sub_cube = state["entries"][1]
+        self.assertEqual(sub_cube["level_name"], "/Game/Maps/Test_Sub")
+        self.assertEqual(sub_cube["translation"], (-50.0, 0.0, 25.5))
+        self.assertEqual(sub_cube["scale"], (2.0, 2.0, 2.0))
+        self.assertFalse(sub_cube["simulating_physics"])
+
+    def test_decode_delta(self):
+        state = decode_state(load_fixture("state_delta.b64"))
+
+        self.assertFalse(state["is_keyframe"])
+        self.assertEqual(state["sequence"], 5)
+        self.assertEqual(state["base_sequence"], 3)
+        self.assertEqual(state["removed"], [("/Game/Maps/Test_Sub", "Cube_2")])
+
+        moved = state["entries"][0]
+        self.assertEqual(moved["actor_name"], "Cube_1")
+        self.assertEqual(moved["translation"], (110.0, 200.0, 300.0))
+        self.assertEqual(moved["linear_velocity"], (4.0, 5.0, 6.0))
+        self.assertNotIn("class_path", moved)
+        self.assertNotIn("actor_data", moved)
+
+        spawned = state["entries"][1]
+        self.assertEqual(spawned["actor_name"], "Cube_3")
+        self.assertEqual(spawned["class_path"], STATIC_MESH_ACTOR)
+        self.assertEqual(spawned["actor_data"], bytes(bytearray([7])))
+
+    def test_mirror_applies_delta_on_keyframe(self):
+        mirror = StateMirror()
+        delta = decode_state(load_fixture("state_delta.b64"))
+
+        self.assertFalse(mirror.apply(delta))
+        self.assertTrue(mirror.apply(decode_state(load_fixture("state_keyframe.b64"))))
+        self.assertTrue(mirror.apply(delta))
+
+        self.assertEqual(sorted(mirror.actors), [("/Game/Maps/Test", "Cube_1"), ("/Game/Maps/Test_Sub", "Cube_3")])
+        cube = mirror.actors[("/Game/Maps/Test", "Cube_1")]
+        self.assertEqual(cube["translation"], (110.0, 200.0, 300.0))
+        self.assertEqual(cube["actor_data"], bytes(bytearray([1, 2, 3, 4])))
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -1,12 +1,16 @@
 #include "ASaveStateActor.h"
 
+#include "Async/Async.h"
 #include "FileHelper.h"
+#include "Engine/Level.h"
 #include "Engine/StaticMeshActor.h"
 #include "FileManagerGeneric.h"
+#include "Misc/Base64.h"
 #include "ROSBridgeGameInstance.h"
 #include "Serialization/BufferArchive.h"
 #include "Serialization/MemoryReader.h"
 #include "USaveState.h"
+#include "std_msgs/String.h"
 
 ASaveStateActor::ASaveStateActor()
 {
@@ -36,6 +40,11 @@ void ASaveStateActor::Tick(float DeltaTime)
 		ActorsToRefreshOnTick.Empty();
 	}
 
+	if (bPublishState)
+	{
+		PublishStateTick(DeltaTime);
+	}
+
 #if WITH_EDITOR
 	// Debug Section
 	if (!bDebug)
@@ -70,25 +79,84 @@ void ASaveStateActor::BeginPlay()
 
 	ActiveGameInstance->ROSHandler->AddServiceServer(SaveService);
 	ActiveGameInstance->ROSHandler->AddServiceServer(LoadService);
+
+	if (bPublishState)
+	{
+		StatePublisher = MakeShareable<FROSBridgePublisher>(new FROSBridgePublisher(StatePublisherTopic, TEXT("std_msgs/String")));
+		StateAckSubscriber = MakeShareable<FROSStateAckSubscriber>(new FROSStateAckSubscriber(StateAckTopic, TEXT("std_msgs/String")));
+
+		ActiveGameInstance->ROSHandler->AddPublisher(StatePublisher);
+		ActiveGameInstance->ROSHandler->AddSubscriber(StateAckSubscriber);
+		BandwidthTokens = PublishBandwidthBudget;
+	}
 	ActiveGameInstance->ROSHandler->Process();
+	ROSHandler = ActiveGameInstance->ROSHandler;
 
 	// Bind Delegates
 	SaveService->OnRosCallback.BindUObject(this, &ASaveStateActor::RosCallSave);
 	LoadService->OnRosCallback.BindUObject(this, &ASaveStateActor::RosCallLoad);
+	if (StateAckSubscriber.IsValid())
+	{
+		StateAckSubscriber->OnRosCallback.BindUObject(this, &ASaveStateActor::RosCallAcknowledge);
+	}
+
+	LevelAddedToWorldHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &ASaveStateActor::OnLevelAddedToWorld);
+	LevelRemovedFromWorldHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &ASaveStateActor::OnLevelRemovedFromWorld);
+}
+
+void ASaveStateActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedToWorldHandle);
+	FWorldDelegates::LevelRemovedFromWorld.Remove(LevelRemovedFromWorldHandle);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ASaveStateActor::OnLevelAddedToWorld(ULevel* InLevel, UWorld* InWorld)
+{
+	if (InWorld != GetWorld() || SavedState == nullptr || !SavedState->HasPendingLevelSections())
+	{
+		return;
+	}
+
+	TArray<AActor*> LoadedActors = SavedState->LoadOntoLevel(InLevel);
+	if (LoadedActors.Num() > 0)
+	{
+		ActorsToRefreshOnTick.Append(LoadedActors);
+		bHasLoadedLastTick = true;
+		UE_LOG(LogTemp, Warning, TEXT("%s: Save loaded onto %s."), TEXT(__FUNCTION__), *InLevel->GetOutermost()->GetName());
+	}
+}
+
+void ASaveStateActor::OnLevelRemovedFromWorld(ULevel* InLevel, UWorld* InWorld)
+{
+	if (InLevel == nullptr || InWorld != GetWorld() || SavedState == nullptr || !bIsSavedStateLoaded)
+	{
+		return;
+	}
+
+	SavedState->MarkLevelSectionPending(InLevel);
 }
 
 void ASaveStateActor::SaveStateCurrentWorld(const FString FileName, const FString FilePath)
 {
-	int32 AmountOfItemsSaved = 0;
+	int32 AmountOfLevelsSaved = 0;
 
+	USaveState* PreviousState = SavedState;
 	SavedState = NewObject<USaveState>();
 	SavedState->SaveFromWorld(GetWorld(), ClassesToSave);
-	TArray<uint8> ByteArray = SavedState->SerializeState(AmountOfItemsSaved);
+	SavedState->AdoptPendingLevelSections(PreviousState);
+	bIsSavedStateLoaded = false;
+	TArray<uint8> ByteArray = SavedState->SerializeState(AmountOfLevelsSaved);
 
 	FBufferArchive SaveData(true);
 	FName WorldName = GetWorld()->GetFName();
+	uint32 FileMagic = SaveFileMagic;
+	uint32 FileVersion = SaveFileVersion;
 	SaveData << WorldName;
-	SaveData << AmountOfItemsSaved;
+	SaveData << FileMagic;
+	SaveData << FileVersion;
+	SaveData << AmountOfLevelsSaved;
 	SaveData << ByteArray;
 	
 	const FString FileToSaveOn = FilePath + GetWorld()->GetName() + "_" + FileName + ".sav";
@@ -101,24 +169,35 @@ void ASaveStateActor::SaveStateCurrentWorld(const FString FileName, const FStrin
 void ASaveStateActor::LoadStateOntoCurrentLevel(const FString FileName, const FString FilePath)
 {
 	SavedState = NewObject<USaveState>();
+	bIsSavedStateLoaded = false;
 
 	const FString FileToLoadPath = FilePath + GetWorld()->GetName() + "_" + FileName + ".sav";
 	TArray<uint8> SavedData;
 	FFileHelper::LoadFileToArray(SavedData, *FileToLoadPath);
 
 	FName WorldName = FName();
-	int ItemsSaved = 0;
+	uint32 FileMagic = 0;
+	uint32 FileVersion = 0;
+	int LevelsSaved = 0;
 	TArray<uint8> SaveData = TArray<uint8>();
 
 	FMemoryReader MemoryReader(SavedData, true);
 	MemoryReader << WorldName;
-	MemoryReader << ItemsSaved;
-	MemoryReader << SaveData;
+	MemoryReader << FileMagic;
+	MemoryReader << FileVersion;
+
+	// Older Layouts are not read any further, their Counts would drive the decoding otherwise.
+	if (!MemoryReader.IsError() && FileMagic == SaveFileMagic && FileVersion == SaveFileVersion)
+	{
+		MemoryReader << LevelsSaved;
+		MemoryReader << SaveData;
+	}
 
-	if (GetWorld()->GetFName() == WorldName)
+	if (GetWorld()->GetFName() == WorldName && FileMagic == SaveFileMagic && FileVersion == SaveFileVersion && !MemoryReader.IsError())
 	{
-		SavedState->ApplySerializeOnState(SaveData, ItemsSaved);
+		SavedState->ApplySerializeOnState(SaveData, LevelsSaved);
 		ActorsToRefreshOnTick = SavedState->LoadOntoWorld(GetWorld());
+		bIsSavedStateLoaded = true;
 		bHasLoadedLastTick = true;
 		UE_LOG(LogTemp, Warning, TEXT("%s: Save loaded."), TEXT(__FUNCTION__));
 		return;
@@ -150,3 +229,116 @@ void ASaveStateActor::RosCallLoad(FString InFileName)
 	}, TStatId(), nullptr, ENamedThreads::GameThread);
 }
 
+void ASaveStateActor::RosCallAcknowledge(FString InKeyframeSequence)
+{
+	const uint32 Sequence = static_cast<uint32>(FCString::Strtoui64(*InKeyframeSequence, nullptr, 10));
+	FFunctionGraphTask::CreateAndDispatchWhenReady([this, Sequence]()
+	{
+		AcknowledgeKeyframe(Sequence);
+	}, TStatId(), nullptr, ENamedThreads::GameThread);
+}
+
+void ASaveStateActor::PublishStateTick(const float DeltaTime)
+{
+	BandwidthTokens = FMath::Min(BandwidthTokens + PublishBandwidthBudget * DeltaTime, static_cast<float>(PublishBandwidthBudget));
+	TimeSinceLastPublish += DeltaTime;
+	TimeSinceLastKeyframe += DeltaTime;
+
+	if (!StatePublisher.IsValid() || bIsEncodingState || TimeSinceLastPublish < 1.f / PublishRate)
+	{
+		return;
+	}
+
+	// Capturing is the expensive Part on the GameThread, so skip it while the Budget is used up.
+	// The Keyframe Exception needs a full Budget, which can't be the Case here either.
+	if (BandwidthTokens <= 0.f)
+	{
+		return;
+	}
+
+	const bool bSendKeyframe = !bHasSentKeyframe || TimeSinceLastKeyframe >= KeyframeInterval;
+	if (!bSendKeyframe && !AcknowledgedKeyframe.IsValid())
+	{
+		// No Base for a Delta until a Mirror acknowledges one of the Keyframes.
+		return;
+	}
+	TimeSinceLastPublish = 0.f;
+
+	TArray<UClass*> ClassesToPublish = TArray<UClass*>();
+	for (TSubclassOf<AActor> ClassToPublish : ClassesToSave)
+	{
+		ClassesToPublish.Add(ClassToPublish.Get());
+	}
+
+	const TSharedPtr<const FStateSnapshot, ESPMode::ThreadSafe> Snapshot = FStateSnapshot::CaptureFromWorld(GetWorld(), ClassesToPublish, NextSnapshotSequence++);
+	const TSharedPtr<const FStateSnapshot, ESPMode::ThreadSafe> Keyframe = bSendKeyframe ? TSharedPtr<const FStateSnapshot, ESPMode::ThreadSafe>() : AcknowledgedKeyframe;
+	bIsEncodingState = true;
+
+	// Snapshots are immutable once captured, so the Encoding does not need to wait on the GameThread.
+	TWeakObjectPtr<ASaveStateActor> WeakThis(this);
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [WeakThis, Snapshot, Keyframe]()
+	{
+		const bool bIsKeyframe = !Keyframe.IsValid();
+		const FString EncodedState = FBase64::Encode(bIsKeyframe ? FStateSnapshot::EncodeKeyframe(*Snapshot) : FStateSnapshot::EncodeDelta(*Keyframe, *Snapshot));
+
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Snapshot, EncodedState, bIsKeyframe]()
+		{
+			if (ASaveStateActor* StrongThis = WeakThis.Get())
+			{
+				StrongThis->PublishEncodedState(Snapshot, EncodedState, bIsKeyframe);
+			}
+		});
+	});
+}
+
+void ASaveStateActor::PublishEncodedState(const TSharedPtr<const FStateSnapshot, ESPMode::ThreadSafe> InSnapshot, const FString& InEncodedState, const bool bIsKeyframe)
+{
+	bIsEncodingState = false;
+
+	// Keyframes larger than the whole Budget may still go out once the Budget has been saved up.
+	const float StateSize = InEncodedState.Len();
+	if (StateSize > BandwidthTokens && !(bIsKeyframe && BandwidthTokens >= PublishBandwidthBudget))
+	{
+		if (bDebug)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("%s: Dropped State %u, exceeding the Bandwidth Budget."), TEXT(__FUNCTION__), InSnapshot->Sequence);
+		}
+		return;
+	}
+
+	BandwidthTokens -= StateSize;
+	ROSHandler->PublishMsg(StatePublisherTopic, MakeShareable(new std_msgs::String(InEncodedState)));
+
+	if (bIsKeyframe)
+	{
+		TimeSinceLastKeyframe = 0.f;
+		bHasSentKeyframe = true;
+		SentKeyframes.Add(InSnapshot->Sequence, InSnapshot);
+
+		while (SentKeyframes.Num() > MaxUnacknowledgedKeyframes)
+		{
+			TArray<uint32> SentSequences = TArray<uint32>();
+			SentKeyframes.GenerateKeyArray(SentSequences);
+			SentKeyframes.Remove(FMath::Min(SentSequences));
+		}
+	}
+}
+
+void ASaveStateActor::AcknowledgeKeyframe(const uint32 InSequence)
+{
+	const TSharedPtr<const FStateSnapshot, ESPMode::ThreadSafe>* Keyframe = SentKeyframes.Find(InSequence);
+	if (Keyframe == nullptr)
+	{
+		// Either unknown or older than the Keyframe acknowledged last.
+		return;
+	}
+
+	AcknowledgedKeyframe = *Keyframe;
+	for (auto It = SentKeyframes.CreateIterator(); It; ++It)
+	{
+		if (It.Key() <= InSequence)
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
@@ -0,0 +1,250 @@
+#include "FStateSnapshot.h"
+
+#include "Components/PrimitiveComponent.h"
+#include "Engine/Level.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+#include "Misc/Crc.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/ObjectAndNameAsStringProxyArchive.h"
+#include "USaveState.h"
+
+/**
+ * Proxy Archive skipping the Properties which move along with the Actor. Only meant for the Actor
+ * itself and its RootComponent, the relative Transforms of other Components stay part of the Data.
+ */
+class FSnapshotActorDataArchive final : public FObjectAndNameAsStringProxyArchive
+{
+public:
+	explicit FSnapshotActorDataArchive(FArchive& InInnerArchive) : FObjectAndNameAsStringProxyArchive(InInnerArchive, true) {}
+
+	virtual bool ShouldSkipProperty(const UProperty* InProperty) const override
+	{
+		static const TArray<FName> SkippedSceneComponentProperties = {
+			FName("RelativeLocation"), FName("RelativeRotation"), FName("RelativeScale3D"), FName("ComponentVelocity")
+		};
+		static const FName ReplicatedMovementName = FName("ReplicatedMovement");
+
+		const UStruct* OwnerStruct = InProperty->GetOwnerStruct();
+		if (OwnerStruct == USceneComponent::StaticClass())
+		{
+			return SkippedSceneComponentProperties.Contains(InProperty->GetFName());
+		}
+		if (OwnerStruct == AActor::StaticClass())
+		{
+			return InProperty->GetFName() == ReplicatedMovementName;
+		}
+		return FObjectAndNameAsStringProxyArchive::ShouldSkipProperty(InProperty);
+	}
+};
+
+TSharedPtr<const FStateSnapshot, ESPMode::ThreadSafe> FStateSnapshot::CaptureFromWorld(UWorld* InWorld, const TArray<UClass*>& InClasses, const uint32 InSequence)
+{
+	check(InWorld);
+	check(IsInGameThread());
+	const TSharedRef<FStateSnapshot, ESPMode::ThreadSafe> OutSnapshot = MakeShared<FStateSnapshot, ESPMode::ThreadSafe>();
+	OutSnapshot->Sequence = InSequence;
+	OutSnapshot->WorldName = InWorld->GetName();
+
+	for (AActor* FoundActor : USaveState::GetActorsOfSavedClasses(InWorld, InClasses))
+	{
+		UPrimitiveComponent* RootRefC = Cast<UPrimitiveComponent>(FoundActor->GetRootComponent());
+		if (RootRefC == nullptr || RootRefC->Mobility == EComponentMobility::Static || !FoundActor->GetLevel()->bIsVisible)
+		{
+			continue;
+		}
+
+		FSnapshotActorState ActorState;
+		ActorState.ActorName = FoundActor->GetName();
+		ActorState.LevelName = USaveState::GetLevelSectionName(FoundActor->GetLevel()).ToString();
+		ActorState.ClassPath = FoundActor->GetClass()->GetPathName();
+		ActorState.ActorTransform = FoundActor->GetActorTransform();
+		ActorState.bIsSimulatingPhysics = RootRefC->IsSimulatingPhysics();
+		if (ActorState.bIsSimulatingPhysics)
+		{
+			ActorState.LinearVelocity = RootRefC->GetPhysicsLinearVelocity();
+			ActorState.AngularVelocity = RootRefC->GetPhysicsAngularVelocityInDegrees();
+		}
+		ActorState.ActorData = SerializeActorData(FoundActor);
+		ActorState.ActorDataHash = FCrc::MemCrc32(ActorState.ActorData.GetData(), ActorState.ActorData.Num());
+
+		OutSnapshot->ActorStates.Emplace(ActorState.LevelName + ":" + ActorState.ActorName, MoveTemp(ActorState));
+	}
+
+	return OutSnapshot;
+}
+
+TArray<uint8> FStateSnapshot::SerializeActorData(AActor* InActor)
+{
+	TArray<uint8> OutputData;
+	FMemoryWriter MemoryWriter(OutputData, true);
+	FSnapshotActorDataArchive TransformlessArchive(MemoryWriter);
+	FObjectAndNameAsStringProxyArchive Archive(MemoryWriter, true);
+	InActor->Serialize(TransformlessArchive);
+
+	// Iterate through the Child Components and serialize them as well.
+	TArray<USceneComponent*> ChildComponents;
+	InActor->GetComponents(ChildComponents);
+
+	for (USceneComponent* CompToSave : ChildComponents)
+	{
+		CompToSave->Serialize(CompToSave == InActor->GetRootComponent() ? static_cast<FArchive&>(TransformlessArchive) : static_cast<FArchive&>(Archive));
+	}
+
+	return OutputData;
+}
+
+TArray<uint8> FStateSnapshot::EncodeKeyframe(const FStateSnapshot& InSnapshot)
+{
+	TArray<uint8> OutByteArray = {};
+	FMemoryWriter MemoryWriter(OutByteArray, true);
+
+	uint8 bIsKeyframe = true;
+	uint32 Sequence = InSnapshot.Sequence;
+	FString WorldName = InSnapshot.WorldName;
+	int32 EntryAmount = InSnapshot.ActorStates.Num();
+	MemoryWriter << bIsKeyframe;
+	MemoryWriter << Sequence;
+	// BaseSequence Slot, a Keyframe is its own Base.
+	MemoryWriter << Sequence;
+	MemoryWriter << WorldName;
+	MemoryWriter << EntryAmount;
+
+	for (const TPair<FString, FSnapshotActorState>& StatePair : InSnapshot.ActorStates)
+	{
+		WriteActorState(MemoryWriter, StatePair.Value, SSF_All);
+	}
+
+	int32 RemovedAmount = 0;
+	MemoryWriter << RemovedAmount;
+
+	return OutByteArray;
+}
+
+TArray<uint8> FStateSnapshot::EncodeDelta(const FStateSnapshot& InKeyframe, const FStateSnapshot& InSnapshot)
+{
+	TArray<uint8> OutByteArray = {};
+	FMemoryWriter MemoryWriter(OutByteArray, true);
+
+	// Collect the changed Entries first, as their Amount is written ahead of them.
+	TArray<TPair<const FSnapshotActorState*, uint8>> ChangedStates = {};
+	for (const TPair<FString, FSnapshotActorState>& StatePair : InSnapshot.ActorStates)
+	{
+		const FSnapshotActorState* BaseState = InKeyframe.ActorStates.Find(StatePair.Key);
+		const uint8 Flags = BaseState != nullptr ? GetChangedFlags(*BaseState, StatePair.Value) : static_cast<uint8>(SSF_All);
+		if (Flags != SSF_None)
+		{
+			ChangedStates.Emplace(&StatePair.Value, Flags);
+		}
+	}
+
+	TArray<const FSnapshotActorState*> RemovedStates = {};
+	for (const TPair<FString, FSnapshotActorState>& StatePair : InKeyframe.ActorStates)
+	{
+		if (!InSnapshot.ActorStates.Contains(StatePair.Key))
+		{
+			RemovedStates.Add(&StatePair.Value);
+		}
+	}
+
+	uint8 bIsKeyframe = false;
+	uint32 Sequence = InSnapshot.Sequence;
+	uint32 BaseSequence = InKeyframe.Sequence;
+	FString WorldName = InSnapshot.WorldName;
+	int32 EntryAmount = ChangedStates.Num();
+	MemoryWriter << bIsKeyframe;
+	MemoryWriter << Sequence;
+	MemoryWriter << BaseSequence;
+	MemoryWriter << WorldName;
+	MemoryWriter << EntryAmount;
+
+	for (const TPair<const FSnapshotActorState*, uint8>& ChangedState : ChangedStates)
+	{
+		WriteActorState(MemoryWriter, *ChangedState.Key, ChangedState.Value);
+	}
+
+	int32 RemovedAmount = RemovedStates.Num();
+	MemoryWriter << RemovedAmount;
+
+	for (const FSnapshotActorState* RemovedState : RemovedStates)
+	{
+		FString LevelName = RemovedState->LevelName;
+		FString ActorName = RemovedState->ActorName;
+		MemoryWriter << LevelName;
+		MemoryWriter << ActorName;
+	}
+
+	return OutByteArray;
+}
+
+void FStateSnapshot::WriteActorState(FArchive& Ar, const FSnapshotActorState& InState, uint8 InFlags)
+{
+	// Archives only take mutable References, hence the Copies.
+	FString LevelName = InState.LevelName;
+	FString ActorName = InState.ActorName;
+	Ar << LevelName;
+	Ar << ActorName;
+	Ar << InFlags;
+
+	if (InFlags & SSF_Class)
+	{
+		FString ClassPath = InState.ClassPath;
+		Ar << ClassPath;
+	}
+
+	// Transform Parts are written one by one, so the Layout does not depend on how FTransform is stored.
+	if (InFlags & SSF_Transform)
+	{
+		FQuat Rotation = InState.ActorTransform.GetRotation();
+		FVector Translation = InState.ActorTransform.GetTranslation();
+		FVector Scale3D = InState.ActorTransform.GetScale3D();
+		Ar << Rotation;
+		Ar << Translation;
+		Ar << Scale3D;
+	}
+
+	if (InFlags & SSF_Physics)
+	{
+		uint8 bIsSimulatingPhysics = InState.bIsSimulatingPhysics;
+		FVector LinearVelocity = InState.LinearVelocity;
+		FVector AngularVelocity = InState.AngularVelocity;
+		Ar << bIsSimulatingPhysics;
+		Ar << LinearVelocity;
+		Ar << AngularVelocity;
+	}
+
+	if (InFlags & SSF_ActorData)
+	{
+		TArray<uint8> ActorData = InState.ActorData;
+		Ar << ActorData;
+	}
+}
+
+uint8 FStateSnapshot::GetChangedFlags(const FSnapshotActorState& InBase, const FSnapshotActorState& InCurrent)
+{
+	uint8 OutFlags = SSF_None;
+
+	if (InBase.ClassPath != InCurrent.ClassPath)
+	{
+		return SSF_All;
+	}
+
+	if (!InBase.ActorTransform.Equals(InCurrent.ActorTransform, KINDA_SMALL_NUMBER))
+	{
+		OutFlags |= SSF_Transform;
+	}
+
+	if (InBase.bIsSimulatingPhysics != InCurrent.bIsSimulatingPhysics
+		|| !InBase.LinearVelocity.Equals(InCurrent.LinearVelocity, KINDA_SMALL_NUMBER)
+		|| !InBase.AngularVelocity.Equals(InCurrent.AngularVelocity, KINDA_SMALL_NUMBER))
+	{
+		OutFlags |= SSF_Physics;
+	}
+
+	if (InBase.ActorDataHash != InCurrent.ActorDataHash || InBase.ActorData.Num() != InCurrent.ActorData.Num())
+	{
+		OutFlags |= SSF_ActorData;
+	}
+
+	return OutFlags;
+}
@@ -0,0 +1,85 @@
+#include "FStateSnapshot.h"
+
+#include "FileHelper.h"
+#include "Interfaces/IPluginManager.h"
+#include "Misc/Crc.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/Base64.h"
+#include "Misc/Paths.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace StateSnapshotTest
+{
+	/** Builds an Actor State the same way the Fixtures in Scripts/Fixtures have been described. */
+	FSnapshotActorState MakeActorState(const FString& InLevelName, const FString& InActorName, const FVector& InTranslation, const FVector& InScale3D,
+		const bool bInIsSimulatingPhysics, const FVector& InLinearVelocity, const FVector& InAngularVelocity, const TArray<uint8>& InActorData)
+	{
+		FSnapshotActorState OutState;
+		OutState.LevelName = InLevelName;
+		OutState.ActorName = InActorName;
+		OutState.ClassPath = TEXT("/Script/Engine.StaticMeshActor");
+		OutState.ActorTransform = FTransform(FQuat::Identity, InTranslation, InScale3D);
+		OutState.bIsSimulatingPhysics = bInIsSimulatingPhysics;
+		OutState.LinearVelocity = InLinearVelocity;
+		OutState.AngularVelocity = InAngularVelocity;
+		OutState.ActorData = InActorData;
+		OutState.ActorDataHash = FCrc::MemCrc32(InActorData.GetData(), InActorData.Num());
+		return OutState;
+	}
+
+	void AddActorState(FStateSnapshot& InOutSnapshot, const FSnapshotActorState& InState)
+	{
+		InOutSnapshot.ActorStates.Add(InState.LevelName + ":" + InState.ActorName, InState);
+	}
+
+	/** Reads a Fixture which is shared with Scripts/test_state_mirror.py. */
+	FString LoadFixture(const FString& InFixtureName)
+	{
+		const TSharedPtr<IPlugin> Plugin = IPluginManager::Get().FindPlugin(TEXT("UStateSavePlugin"));
+		FString OutFixture;
+		if (Plugin.IsValid())
+		{
+			FFileHelper::LoadFileToString(OutFixture, *FPaths::Combine(Plugin->GetBaseDir(), TEXT("Scripts/Fixtures"), InFixtureName));
+		}
+		return OutFixture.TrimStartAndEnd();
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FStateSnapshotEncodingTest, "UStateSavePlugin.StateSnapshot.Encoding",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FStateSnapshotEncodingTest::RunTest(const FString& Parameters)
+{
+	using namespace StateSnapshotTest;
+
+	const FSnapshotActorState Cube = MakeActorState(TEXT("/Game/Maps/Test"), TEXT("Cube_1"), FVector(100.f, 200.f, 300.f), FVector(1.f),
+		true, FVector(1.f, 2.f, 3.f), FVector(0.f, 0.f, 90.f), {1, 2, 3, 4});
+	const FSnapshotActorState SubCube = MakeActorState(TEXT("/Game/Maps/Test_Sub"), TEXT("Cube_2"), FVector(-50.f, 0.f, 25.5f), FVector(2.f),
+		false, FVector::ZeroVector, FVector::ZeroVector, {5, 6});
+
+	FStateSnapshot Keyframe;
+	Keyframe.Sequence = 3;
+	Keyframe.WorldName = TEXT("TestWorld");
+	AddActorState(Keyframe, Cube);
+	AddActorState(Keyframe, SubCube);
+
+	// Cube_1 moves, Cube_2 is gone and Cube_3 has been spawned since the Keyframe.
+	FSnapshotActorState MovedCube = Cube;
+	MovedCube.ActorTransform.SetTranslation(FVector(110.f, 200.f, 300.f));
+	MovedCube.LinearVelocity = FVector(4.f, 5.f, 6.f);
+
+	FStateSnapshot Snapshot;
+	Snapshot.Sequence = 5;
+	Snapshot.WorldName = TEXT("TestWorld");
+	AddActorState(Snapshot, MovedCube);
+	AddActorState(Snapshot, MakeActorState(TEXT("/Game/Maps/Test_Sub"), TEXT("Cube_3"), FVector::ZeroVector, FVector(1.f),
+		false, FVector::ZeroVector, FVector::ZeroVector, {7}));
+
+	TestEqual(TEXT("Keyframe matches state_keyframe.b64"), FBase64::Encode(FStateSnapshot::EncodeKeyframe(Keyframe)), LoadFixture(TEXT("state_keyframe.b64")));
+	TestEqual(TEXT("Delta matches state_delta.b64"), FBase64::Encode(FStateSnapshot::EncodeDelta(Keyframe, Snapshot)), LoadFixture(TEXT("state_delta.b64")));
+
+	return true;
+}
+
+#endif
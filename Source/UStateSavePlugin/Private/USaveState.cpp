@@ -1,6 +1,8 @@
 #include "USaveState.h"
 
+#include "Async/ParallelFor.h"
 #include "Components/PrimitiveComponent.h"
+#include "Engine/Level.h"
 #include "Engine/StaticMeshActor.h"
 #include "Engine/World.h"
 #include "FileManagerGeneric.h"
@@ -19,27 +21,42 @@ void USaveState::ClearContents()
 
 bool USaveState::SaveFromWorld(UWorld * InWorld, const TArray<TSubclassOf<AActor>>& InClasses)
 {
+	check(InWorld);
 	ClearContents();
 
 	for (TSubclassOf<AActor> ClassToSave : InClasses)
 	{
 		SavedClasses.Add(ClassToSave.Get());
 	}
-	
-	TArray<AActor*> ActorsToSave = GetActorsOfSavedClasses(InWorld, SavedClasses);
-	for (AActor* FoundActor : ActorsToSave)
+
+	for (ULevel* Level : InWorld->GetLevels())
 	{
-		UPrimitiveComponent* RootRefC = Cast<UPrimitiveComponent>(FoundActor->GetRootComponent());
-		if (RootRefC != nullptr && (RootRefC->Mobility == EComponentMobility::Movable || RootRefC->Mobility == EComponentMobility::Stationary))
+		if (Level == nullptr || !Level->bIsVisible)
 		{
-			FSavedObjectInfo* ObjectSpawnInfo = new FSavedObjectInfo();
-			ObjectSpawnInfo->ActorName = FoundActor->GetFName();
-			ObjectSpawnInfo->ActorTransform = FoundActor->GetActorTransform();
-			ObjectSpawnInfo->ActorClass = FoundActor->GetClass();
-			ObjectSpawnInfo->bIsSimulatingPhysics = RootRefC->IsSimulatingPhysics();
-			ObjectSpawnInfo->ActorData = SerializeActor(FoundActor);
-
-			SavedState.Emplace(FoundActor->GetName(), ObjectSpawnInfo);
+			continue;
+		}
+
+		// Every visible Level gets a Section, even an empty one, so loading knows which Actors to remove.
+		FSavedLevelSection& Section = SavedState.Emplace(GetLevelSectionName(Level), FSavedLevelSection(GetLevelSectionName(Level)));
+
+		// Freshly saved Sections mirror the World already and must not be applied on stream-in.
+		Section.bIsApplied = true;
+
+		TArray<AActor*> ActorsToSave = GetActorsOfSavedClassesInLevel(Level, SavedClasses);
+		for (AActor* FoundActor : ActorsToSave)
+		{
+			UPrimitiveComponent* RootRefC = Cast<UPrimitiveComponent>(FoundActor->GetRootComponent());
+			if (RootRefC != nullptr && (RootRefC->Mobility == EComponentMobility::Movable || RootRefC->Mobility == EComponentMobility::Stationary))
+			{
+				FSavedObjectInfo* ObjectSpawnInfo = new FSavedObjectInfo();
+				ObjectSpawnInfo->ActorName = FoundActor->GetFName();
+				ObjectSpawnInfo->ActorTransform = FoundActor->GetActorTransform();
+				ObjectSpawnInfo->ActorClass = FoundActor->GetClass();
+				ObjectSpawnInfo->bIsSimulatingPhysics = RootRefC->IsSimulatingPhysics();
+				ObjectSpawnInfo->ActorData = SerializeActor(FoundActor);
+
+				Section.SavedObjects.Emplace(FoundActor->GetName(), ObjectSpawnInfo);
+			}
 		}
 	}
 	return true;
@@ -47,15 +64,94 @@ bool USaveState::SaveFromWorld(UWorld * InWorld, const TArray<TSubclassOf<AActor
 
 TArray<AActor*> USaveState::LoadOntoWorld(UWorld * InWorld)
 {
-	TMap<FString, FSavedObjectInfo*> CopiedMap = SavedState;
+	check(InWorld);
+	TArray<AActor*> OutActorArray = TArray<AActor*>();
+
+	// Only visible Levels are handled here, the others are applied once they have been streamed in.
+	for (ULevel* Level : InWorld->GetLevels())
+	{
+		if (Level != nullptr && Level->bIsVisible)
+		{
+			OutActorArray.Append(LoadOntoLevel(Level));
+		}
+	}
+
+	return OutActorArray;
+}
+
+TArray<AActor*> USaveState::LoadOntoLevel(ULevel* InLevel)
+{
+	check(InLevel);
+	FSavedLevelSection* Section = SavedState.Find(GetLevelSectionName(InLevel));
+	if (Section == nullptr || Section->bIsApplied)
+	{
+		return TArray<AActor*>();
+	}
+
+	Section->bIsApplied = true;
+	return ApplySectionOnLevel(*Section, InLevel);
+}
+
+void USaveState::MarkLevelSectionPending(const ULevel* InLevel)
+{
+	check(InLevel);
+	if (FSavedLevelSection* Section = SavedState.Find(GetLevelSectionName(InLevel)))
+	{
+		Section->bIsApplied = false;
+	}
+}
+
+bool USaveState::HasPendingLevelSections() const
+{
+	for (const TPair<FName, FSavedLevelSection>& SectionPair : SavedState)
+	{
+		if (!SectionPair.Value.bIsApplied)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void USaveState::AdoptPendingLevelSections(const USaveState* InPreviousState)
+{
+	if (InPreviousState == nullptr)
+	{
+		return;
+	}
+
+	for (const TPair<FName, FSavedLevelSection>& SectionPair : InPreviousState->SavedState)
+	{
+		if (SectionPair.Value.bIsApplied || SavedState.Contains(SectionPair.Key))
+		{
+			continue;
+		}
+
+		SavedState.Add(SectionPair.Key, SectionPair.Value);
+		for (const TPair<FString, FSavedObjectInfo*>& ObjectPair : SectionPair.Value.SavedObjects)
+		{
+			if (!SavedClasses.Contains(ObjectPair.Value->ActorClass))
+			{
+				SavedClasses.Add(ObjectPair.Value->ActorClass);
+			}
+		}
+	}
+}
+
+TArray<AActor*> USaveState::ApplySectionOnLevel(FSavedLevelSection& InSection, ULevel* InLevel)
+{
+	UWorld* InWorld = InLevel->GetWorld();
+	check(InWorld);
+
+	TMap<FString, FSavedObjectInfo*> CopiedMap = InSection.SavedObjects;
 	TSet<AActor*> ActorsToDelete = TSet<AActor*>();
-	TArray<AActor*> ActorArray = GetActorsOfSavedClasses(InWorld, SavedClasses);
+	TArray<AActor*> ActorArray = GetActorsOfSavedClassesInLevel(InLevel, SavedClasses);
 	TArray<AActor*> OutActorArray = TArray<AActor*>();
 
 	// Move Objects if they still reside within the Level.
 	for (AActor* FoundActor : ActorArray)
 	{
-		if (FSavedObjectInfo** SavedObjectInfo = SavedState.Find(FoundActor->GetName()))
+		if (FSavedObjectInfo** SavedObjectInfo = InSection.SavedObjects.Find(FoundActor->GetName()))
 		{
 			FSavedObjectInfo* SavedInfo = *SavedObjectInfo;
 			FoundActor->SetActorRelativeTransform(SavedInfo->ActorTransform);
@@ -94,14 +190,19 @@ TArray<AActor*> USaveState::LoadOntoWorld(UWorld * InWorld)
 	CopiedMap.GenerateValueArray(SaveStateObjectInfo);
 	for (int i = 0; SaveStateObjectInfo.IsValidIndex(i); i++)
 	{
-		// Spawn Actors and then update their Actor Transform.
+		// Spawn Actors into the Level they were saved from and then update their Actor Transform.
 		FSavedObjectInfo* ObjectRecord = SaveStateObjectInfo[i];
 
 		FActorSpawnParameters SpawnParameters;
 		SpawnParameters.Name = ObjectRecord->ActorName;
-		SpawnParameters.OverrideLevel = InWorld->PersistentLevel;
+		SpawnParameters.OverrideLevel = InLevel;
 		FTransform TempTransform = FTransform();
 		AActor* NewActor = InWorld->SpawnActor(ObjectRecord->ActorClass, &TempTransform, SpawnParameters);
+		if (NewActor == nullptr)
+		{
+			UE_LOG(LogTemp, Error, TEXT("%s: Could not respawn %s."), TEXT(__FUNCTION__), *ObjectRecord->ActorName.ToString());
+			continue;
+		}
 		
 		NewActor->SetActorRelativeTransform(ObjectRecord->ActorTransform);
 		ApplySerializationActor(ObjectRecord->ActorData, NewActor);
@@ -122,25 +223,33 @@ TArray<AActor*> USaveState::LoadOntoWorld(UWorld * InWorld)
 	return OutActorArray;
 }
 
-TArray<uint8> USaveState::SerializeState(int32& OutSavedItemAmount) const
+TArray<uint8> USaveState::SerializeState(int32& OutSavedLevelAmount) const
 {
 	TArray<uint8> OutByteArray = {};
-	TArray<FSavedObjectInfo*> SaveStateValueArray = {};
-	
+	TArray<FSavedLevelSection> Sections = {};
+	SavedState.GenerateValueArray(Sections);
+
+	// Sections only touch their own Data, so they can be encoded independently.
+	ParallelFor(Sections.Num(), [&Sections](const int32 Index)
+	{
+		EncodeSection(Sections[Index]);
+	});
+
 	FMemoryWriter MemoryWriter(OutByteArray, true);
 	FObjectAndNameAsStringProxyArchive Archive(MemoryWriter, true);
-	
-	SavedState.GenerateValueArray(SaveStateValueArray);
 
-	for (OutSavedItemAmount = 0; OutSavedItemAmount < SavedState.Num(); OutSavedItemAmount++)
+	for (OutSavedLevelAmount = 0; OutSavedLevelAmount < Sections.Num(); OutSavedLevelAmount++)
 	{
-		Archive << SaveStateValueArray[OutSavedItemAmount];
+		FSavedLevelSection& Section = Sections[OutSavedLevelAmount];
+		Archive << Section.LevelName;
+		Archive << Section.SavedItemAmount;
+		Archive << Section.SectionData;
 	}
 
 	return OutByteArray;
 }
 
-void USaveState::ApplySerializeOnState(const TArray<uint8> ByteArray, const int& InSavedItemAmount)
+void USaveState::ApplySerializeOnState(const TArray<uint8> ByteArray, const int& InSavedLevelAmount)
 {
 	FMemoryReader MemoryReader(ByteArray, true);
 	FObjectAndNameAsStringProxyArchive Archive(MemoryReader, true);
@@ -150,24 +259,60 @@ void USaveState::ApplySerializeOnState(const TArray<uint8> ByteArray, const int&
 		SavedState.Empty();
 	}
 
-	for (int Counter = 0; InSavedItemAmount > Counter; Counter++)
+	TArray<FSavedLevelSection> Sections = TArray<FSavedLevelSection>();
+	for (int Counter = 0; InSavedLevelAmount > Counter; Counter++)
 	{
-		FString ObjectName = FString();
-		FSavedObjectInfo* ObjectData = new FSavedObjectInfo();
-		
-		Archive << ObjectData;
-		ObjectName = ObjectData->ActorName.ToString();
+		FSavedLevelSection& Section = Sections.AddDefaulted_GetRef();
+		Archive << Section.LevelName;
+		Archive << Section.SavedItemAmount;
+		Archive << Section.SectionData;
+	}
+
+	// Classes may only be loaded on the GameThread, so the parallel Pass only finds them. Sections missing one are decoded again afterwards.
+	TArray<bool> DecodeResults = TArray<bool>();
+	DecodeResults.SetNumZeroed(Sections.Num());
+	ParallelFor(Sections.Num(), [&Sections, &DecodeResults](const int32 Index)
+	{
+		DecodeResults[Index] = DecodeSection(Sections[Index], false);
+	});
+
+	for (int Index = 0; Sections.IsValidIndex(Index); Index++)
+	{
+		FSavedLevelSection& Section = Sections[Index];
+		if (!DecodeResults[Index] && !DecodeSection(Section, true))
+		{
+			UE_LOG(LogTemp, Error, TEXT("%s: Could not resolve all Classes of Level %s."), TEXT(__FUNCTION__), *Section.LevelName.ToString());
+		}
 
-		if (!SavedClasses.Contains(ObjectData->ActorClass))
+		for (auto It = Section.SavedObjects.CreateIterator(); It; ++It)
 		{
-			SavedClasses.Add(ObjectData->ActorClass);
+			// Records without a Class can't be respawned, so they are dropped.
+			if (It.Value()->ActorClass == nullptr)
+			{
+				UE_LOG(LogTemp, Error, TEXT("Skipping %s, its Class could not be resolved."), *It.Key());
+				delete It.Value();
+				It.RemoveCurrent();
+				continue;
+			}
+
+			if (!SavedClasses.Contains(It.Value()->ActorClass))
+			{
+				SavedClasses.Add(It.Value()->ActorClass);
+			}
+			UE_LOG(LogTemp, Warning, TEXT("Adding %s"), *It.Key());
 		}
-		UE_LOG(LogTemp, Warning, TEXT("Adding %s"), *ObjectName);
 
-		SavedState.Add(ObjectName, ObjectData);
+		Section.SectionData.Empty();
+		SavedState.Add(Section.LevelName, Section);
 	}
 }
 
+FName USaveState::GetLevelSectionName(const ULevel* InLevel)
+{
+	check(InLevel);
+	return FName(*UWorld::RemovePIEPrefix(InLevel->GetOutermost()->GetName()));
+}
+
 TArray<AActor*> USaveState::GetActorsOfSavedClasses(UWorld* InWorld, TArray<UClass*> InClassArray)
 {
 	check(InWorld);
@@ -183,6 +328,70 @@ TArray<AActor*> USaveState::GetActorsOfSavedClasses(UWorld* InWorld, TArray<UCla
 	return OutArray;
 }
 
+TArray<AActor*> USaveState::GetActorsOfSavedClassesInLevel(ULevel* InLevel, const TArray<UClass*>& InClassArray)
+{
+	check(InLevel);
+	TArray<AActor*> OutArray = TArray<AActor*>();
+
+	for (AActor* LevelActor : InLevel->Actors)
+	{
+		if (LevelActor == nullptr || LevelActor->IsPendingKill())
+		{
+			continue;
+		}
+
+		for (UClass* RefClass : InClassArray)
+		{
+			if (LevelActor->IsA(RefClass))
+			{
+				OutArray.Add(LevelActor);
+				break;
+			}
+		}
+	}
+
+	return OutArray;
+}
+
+void USaveState::EncodeSection(FSavedLevelSection& InOutSection)
+{
+	InOutSection.SectionData.Empty();
+	FMemoryWriter MemoryWriter(InOutSection.SectionData, true);
+	FObjectAndNameAsStringProxyArchive Archive(MemoryWriter, true);
+
+	TArray<FSavedObjectInfo*> SectionValueArray = {};
+	InOutSection.SavedObjects.GenerateValueArray(SectionValueArray);
+
+	for (InOutSection.SavedItemAmount = 0; InOutSection.SavedItemAmount < SectionValueArray.Num(); InOutSection.SavedItemAmount++)
+	{
+		Archive << SectionValueArray[InOutSection.SavedItemAmount];
+	}
+}
+
+bool USaveState::DecodeSection(FSavedLevelSection& InOutSection, const bool bLoadIfFindFails)
+{
+	for (const TPair<FString, FSavedObjectInfo*>& ObjectPair : InOutSection.SavedObjects)
+	{
+		delete ObjectPair.Value;
+	}
+	InOutSection.SavedObjects.Empty();
+
+	FMemoryReader MemoryReader(InOutSection.SectionData, true);
+	FObjectAndNameAsStringProxyArchive Archive(MemoryReader, bLoadIfFindFails);
+	bool bResolvedAllClasses = true;
+
+	for (int Counter = 0; InOutSection.SavedItemAmount > Counter; Counter++)
+	{
+		FSavedObjectInfo* ObjectData = new FSavedObjectInfo();
+		Archive << ObjectData;
+
+		bResolvedAllClasses &= ObjectData->ActorClass != nullptr;
+		InOutSection.SavedObjects.Add(ObjectData->ActorName.ToString(), ObjectData);
+	}
+
+	return bResolvedAllClasses;
+}
+
 TArray<uint8> USaveState::SerializeActor(AActor* InActor)
 {
 	TArray<uint8> OutputData;
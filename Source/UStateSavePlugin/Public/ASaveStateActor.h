@@ -5,7 +5,11 @@
 #include "CoreMinimal.h"
 #include "FROSLoadStateLevel.h"
 #include "FROSSaveStateLevel.h"
+#include "FROSStateAckSubscriber.h"
+#include "FStateSnapshot.h"
 #include "GameFramework/Actor.h"
+#include "ROSBridgeHandler.h"
+#include "ROSBridgePublisher.h"
 #include "USaveState.h"
 #include "ASaveStateActor.generated.h"
 
@@ -21,12 +25,31 @@ public:
 	UPROPERTY(EditAnywhere)
 	bool bLoad = false;
 
+	/** Whether to periodically publish the State of the World onto StatePublisherTopic. */
+	UPROPERTY(EditAnywhere, Category = "Publisher")
+	bool bPublishState = false;
+	/** How many States are published per Second. */
+	UPROPERTY(EditAnywhere, Category = "Publisher", meta = (ClampMin = "0.1"))
+	float PublishRate = 10.f;
+	/** Bytes per Second which may be published at most. */
+	UPROPERTY(EditAnywhere, Category = "Publisher", meta = (ClampMin = "1"))
+	int32 PublishBandwidthBudget = 256 * 1024;
+	/** Seconds between two Keyframes, every other State is published as a Delta. */
+	UPROPERTY(EditAnywhere, Category = "Publisher", meta = (ClampMin = "0.1"))
+	float KeyframeInterval = 5.f;
+
 	// ROS Services
 	TSharedPtr<FROSSaveStateLevel> SaveService;
 	TSharedPtr<FROSLoadStateLevel> LoadService;
 
+	// ROS Publisher Mode
+	TSharedPtr<FROSBridgePublisher> StatePublisher;
+	TSharedPtr<FROSStateAckSubscriber> StateAckSubscriber;
+
 	const FString SaveServiceTopic = FString("/unreal_save_system/ue4_ros_save");
 	const FString LoadServiceTopic = FString("/unreal_save_system/ue4_ros_load");
+	const FString StatePublisherTopic = FString("/unreal_save_system/ue4_ros_state");
+	const FString StateAckTopic = FString("/unreal_save_system/ue4_ros_state_ack");
 
 	UPROPERTY(EditAnywhere)
 	TArray<TSubclassOf<AActor>> ClassesToSave;
@@ -51,16 +74,30 @@ public:
 	UFUNCTION()
 	void RosCallLoad(FString InFileName);
 
+	/**
+	 *	Delegate Function which is called if a Mirror acknowledges a Keyframe.
+	 *
+	 *	@param InKeyframeSequence A String holding the Sequence Number of the Keyframe.
+	 */
+	UFUNCTION()
+	void RosCallAcknowledge(FString InKeyframeSequence);
+
 	UFUNCTION()
 	TArray<FString> ListAllSaveFilesAtLocation() const;
 
 protected:
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 private:
 	UPROPERTY(EditAnywhere)
 	FString SaveSlotName = "Foobar";
 	const FString SaveFilePath = FPaths::ProjectSavedDir() + "UStateSavePlugin/";
+
+	/** Written after the WorldName, so files of other Layouts are rejected instead of decoded. */
+	const uint32 SaveFileMagic = 0x56535355; // "USSV"
+	const uint32 SaveFileVersion = 2;
 	
 	UPROPERTY()
 	USaveState* SavedState;
@@ -71,6 +108,72 @@ private:
 	/** Array of Actors which will be refreshed for a Workaround. */
 	UPROPERTY()
 	TArray<AActor*> ActorsToRefreshOnTick = TArray<AActor*>();
+
+	/** Handle of the Binding to FWorldDelegates::LevelAddedToWorld. */
+	FDelegateHandle LevelAddedToWorldHandle;
+	/** Handle of the Binding to FWorldDelegates::LevelRemovedFromWorld. */
+	FDelegateHandle LevelRemovedFromWorldHandle;
+
+	/** Whether SavedState came from a Load, only then Levels streaming back in get it reapplied. */
+	bool bIsSavedStateLoaded = false;
+
+	/**
+	 * Applies pending Sections of the loaded SaveState once their streamed Level has been added.
+	 *
+	 * @param InLevel Level which has been added.
+	 * @param InWorld World to which the Level has been added.
+	 */
+	void OnLevelAddedToWorld(ULevel* InLevel, UWorld* InWorld);
+
+	/**
+	 * Marks the Section of a streamed out Level pending again, as long as the SaveState came from a Load.
+	 *
+	 * @param InLevel Level which has been removed, null if the whole World is being cleaned up.
+	 * @param InWorld World from which the Level has been removed.
+	 */
+	void OnLevelRemovedFromWorld(ULevel* InLevel, UWorld* InWorld);
+
+	TSharedPtr<FROSBridgeHandler> ROSHandler;
+
+	/** Sequence Number given to the next captured Snapshot. */
+	uint32 NextSnapshotSequence = 0;
+	float TimeSinceLastPublish = 0.f;
+	/** Bytes which may currently be published, refilled by PublishBandwidthBudget each Second. */
+	float BandwidthTokens = 0.f;
+	/** Time since the last Keyframe has been published, accumulated like TimeSinceLastPublish. */
+	float TimeSinceLastKeyframe = 0.f;
+	bool bHasSentKeyframe = false;
+	/** Whether a Snapshot is currently being encoded off the GameThread. */
+	bool bIsEncodingState = false;
+
+	/** Latest Keyframe acknowledged by the Mirrors, Deltas are encoded against it. Snapshots are shared with the Encoding Task, hence ThreadSafe. */
+	TSharedPtr<const FStateSnapshot, ESPMode::ThreadSafe> AcknowledgedKeyframe;
+	/** Published Keyframes which have not been acknowledged yet. */
+	TMap<uint32, TSharedPtr<const FStateSnapshot, ESPMode::ThreadSafe>> SentKeyframes = TMap<uint32, TSharedPtr<const FStateSnapshot, ESPMode::ThreadSafe>>();
+	const int32 MaxUnacknowledgedKeyframes = 8;
+
+	/**
+	 * Captures a Snapshot if it is time to publish and hands it off to be encoded.
+	 *
+	 * @param DeltaTime Time since the last Tick.
+	 */
+	void PublishStateTick(float DeltaTime);
+
+	/**
+	 * Publishes an encoded Snapshot, as long as it fits into the Bandwidth Budget.
+	 *
+	 * @param InSnapshot Snapshot which has been encoded.
+	 * @param InEncodedState Base64 encoded State to publish.
+	 * @param bIsKeyframe Whether the State has been encoded as a Keyframe.
+	 */
+	void PublishEncodedState(TSharedPtr<const FStateSnapshot, ESPMode::ThreadSafe> InSnapshot, const FString& InEncodedState, bool bIsKeyframe);
+
+	/**
+	 * Uses the given Keyframe as the Base for upcoming Deltas.
+	 *
+	 * @param InSequence Sequence Number of the acknowledged Keyframe.
+	 */
+	void AcknowledgeKeyframe(uint32 InSequence);
 	
 	/**
 	 * Saves the current State of the World into a File.
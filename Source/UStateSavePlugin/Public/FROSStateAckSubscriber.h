@@ -0,0 +1,26 @@
+#pragma once
+
+#include "ROSBridgeSubscriber.h"
+#include "std_msgs/String.h"
+
+DECLARE_DELEGATE_OneParam(FRosCallback, FString);
+
+class FROSStateAckSubscriber final : public FROSBridgeSubscriber
+{
+public:
+	FRosCallback OnRosCallback;
+	FROSStateAckSubscriber(const FString InTopic, FString InType) : FROSBridgeSubscriber(InTopic, InType) {}
+
+	TSharedPtr<FROSBridgeMsg> ParseMessage(TSharedPtr<FJsonObject> JsonObject) const override
+	{
+		const TSharedPtr<std_msgs::String> Message = MakeShareable(new std_msgs::String());
+		Message->FromJson(JsonObject);
+		return StaticCastSharedPtr<FROSBridgeMsg>(Message);
+	}
+
+	void Callback(TSharedPtr<FROSBridgeMsg> InMsg) override
+	{
+		const TSharedPtr<std_msgs::String> Message = StaticCastSharedPtr<std_msgs::String>(InMsg);
+		OnRosCallback.ExecuteIfBound(Message->GetData());
+	}
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AActor;
+class UWorld;
+
+/** Flags marking which Parts of an Actor State are contained in a published Entry. */
+enum EStateSnapshotFlags : uint8
+{
+	SSF_None = 0,
+	SSF_Transform = 1 << 0,
+	SSF_Physics = 1 << 1,
+	SSF_ActorData = 1 << 2,
+	SSF_Class = 1 << 3,
+	SSF_All = SSF_Transform | SSF_Physics | SSF_ActorData | SSF_Class
+};
+
+/**
+ * Compact State of a single Actor, holding its Transform, Physics State and serialized Bytes.
+ */
+struct FSnapshotActorState
+{
+	FString ActorName;
+	FString LevelName;
+	FString ClassPath;
+	FTransform ActorTransform = FTransform();
+	bool bIsSimulatingPhysics = false;
+	FVector LinearVelocity = FVector::ZeroVector;
+	FVector AngularVelocity = FVector::ZeroVector;
+	TArray<uint8> ActorData = TArray<uint8>();
+	uint32 ActorDataHash = 0;
+};
+
+/**
+ * Snapshot of the World which is published to external Mirrors. Capturing has to happen on the
+ * GameThread, while encoding only reads the Snapshot and can therefore run on any Thread.
+ */
+class USTATESAVEPLUGIN_API FStateSnapshot
+{
+public:
+	/** Sequence Number of this Snapshot, Keyframes are acknowledged by it. */
+	uint32 Sequence = 0;
+	FString WorldName;
+
+	/** Actor States keyed by their Level and Actor Name. */
+	TMap<FString, FSnapshotActorState> ActorStates = TMap<FString, FSnapshotActorState>();
+
+	/**
+	 * Captures the State of all movable Actors of the given Classes within the visible Levels.
+	 *
+	 * @param InWorld World from which to capture.
+	 * @param InClasses Array of AActor Classes which to capture.
+	 * @param InSequence Sequence Number to give the Snapshot.
+	 * @return The captured Snapshot.
+	 */
+	static TSharedPtr<const FStateSnapshot, ESPMode::ThreadSafe> CaptureFromWorld(UWorld* InWorld, const TArray<UClass*>& InClasses, uint32 InSequence);
+
+	/**
+	 * Encodes the whole Snapshot, to be used as a Keyframe by the Mirrors.
+	 *
+	 * @param InSnapshot Snapshot to encode.
+	 * @return The encoded Keyframe.
+	 */
+	static TArray<uint8> EncodeKeyframe(const FStateSnapshot& InSnapshot);
+
+	/**
+	 * Encodes only the Parts of the Snapshot which differ from the given Keyframe.
+	 *
+	 * @param InKeyframe Keyframe which has been acknowledged by the Mirrors.
+	 * @param InSnapshot Snapshot to encode.
+	 * @return The encoded Delta.
+	 */
+	static TArray<uint8> EncodeDelta(const FStateSnapshot& InKeyframe, const FStateSnapshot& InSnapshot);
+
+private:
+	/**
+	 * Serializes the Actor and its Components, leaving out what is already published as Transform or
+	 * Physics State, so moving Actors do not change their serialized Bytes.
+	 *
+	 * @param InActor Actor pointer from which to Serialize the Data.
+	 * @return ByteArray representing the data of the InActor.
+	 */
+	static TArray<uint8> SerializeActorData(AActor* InActor);
+
+	/**
+	 * Writes the flagged Parts of an Actor State into the Archive.
+	 *
+	 * @param Ar Archive to write into.
+	 * @param InState Actor State to write.
+	 * @param InFlags Combination of EStateSnapshotFlags marking what to write.
+	 */
+	static void WriteActorState(FArchive& Ar, const FSnapshotActorState& InState, uint8 InFlags);
+
+	/**
+	 * Compares two States of the same Actor.
+	 *
+	 * @param InBase State within the Keyframe.
+	 * @param InCurrent Current State.
+	 * @return Combination of EStateSnapshotFlags marking what has changed.
+	 */
+	static uint8 GetChangedFlags(const FSnapshotActorState& InBase, const FSnapshotActorState& InCurrent);
+};
@@ -55,6 +55,38 @@ public:
 	}
 };
 
+/**
+ * Part of a SaveState which belongs to a single ULevel. Sections are encoded and decoded
+ * independently from each other and applied whenever their Level is added to the World.
+ */
+USTRUCT()
+struct FSavedLevelSection
+{
+	GENERATED_USTRUCT_BODY()
+
+public:
+	/** Package Name of the Level this Section belongs to, without any PIE Prefix. */
+	FName LevelName;
+	TMap<FString, FSavedObjectInfo*> SavedObjects;
+	TArray<uint8> SectionData;
+	int32 SavedItemAmount = 0;
+	bool bIsApplied = false;
+
+	FSavedLevelSection()
+	{
+		LevelName = FName();
+		SavedObjects = TMap<FString, FSavedObjectInfo*>();
+		SectionData = TArray<uint8>();
+	}
+
+	explicit FSavedLevelSection(const FName InLevelName)
+	{
+		LevelName = InLevelName;
+		SavedObjects = TMap<FString, FSavedObjectInfo*>();
+		SectionData = TArray<uint8>();
+	}
+};
+
 
 UCLASS()
 class USTATESAVEPLUGIN_API USaveState : public UObject
@@ -62,13 +94,14 @@ class USTATESAVEPLUGIN_API USaveState : public UObject
 	GENERATED_BODY()
 
 public:
-	/** SaveState represented by a TMap and a custom struct. */
-	TMap<FString, FSavedObjectInfo*> SavedState = TMap<FString, FSavedObjectInfo*>();
+	/** SaveState represented by a TMap of Level Sections, keyed by the Name of their Level. */
+	TMap<FName, FSavedLevelSection> SavedState = TMap<FName, FSavedLevelSection>();
 
 	USaveState(){};
 
 	/**
-	 * Initiates the Saving Process and saves all actors who are from the same Subclass of Actors
+	 * Initiates the Saving Process and saves all actors who are from the same Subclass of Actors.
+	 * Every Level which is currently visible in the World gets its own Section.
 	 *
 	 * @param InWorld World from which to save into the SaveState.
 	 * @param InClasses Array of AActor Classes which to serialize and save in the given world.
@@ -78,6 +111,7 @@ public:
 
 	/**
 	 * Initiates the Loading Process and applies the saved Byte Array onto the World.
+	 * Sections of Levels which are not visible yet stay pending, see LoadOntoLevel.
 	 *
 	 * @param InWorld World into which to load the SaveState onto.
 	 * @return List of Actors which have been loaded
@@ -85,20 +119,57 @@ public:
 	TArray<AActor*> LoadOntoWorld(UWorld* InWorld);
 
 	/**
-	 * Function to Serialize the SaveState. To be used along to bring it into an USaveGame
+	 * Applies the pending Section belonging to the given Level, if there is any.
+	 * Meant to be called once a streamed Level has been added to the World.
 	 *
-	 * @param OutSavedItemAmount An reference to an uint8 on which we're to track how many items we've saved.
+	 * @param InLevel Level onto which to load its Section.
+	 * @return List of Actors which have been loaded
+	 */
+	TArray<AActor*> LoadOntoLevel(ULevel* InLevel);
+
+	/**
+	 * Marks the Section of the given Level as pending again, so it is reapplied on the next stream-in.
+	 *
+	 * @param InLevel Level which has been removed from the World.
+	 */
+	void MarkLevelSectionPending(const ULevel* InLevel);
+
+	/** Whether there are Sections left which have not been applied onto their Level yet. */
+	bool HasPendingLevelSections() const;
+
+	/**
+	 * Takes over the pending Sections of a previous SaveState for Levels which have not been saved
+	 * here, so Levels that have not streamed in since the last Load keep their loaded Data.
+	 *
+	 * @param InPreviousState SaveState which has been in use before this one.
+	 */
+	void AdoptPendingLevelSections(const USaveState* InPreviousState);
+
+	/**
+	 * Function to Serialize the SaveState. To be used along to bring it into an USaveGame.
+	 * The Sections are encoded in parallel and then written one after another.
+	 *
+	 * @param OutSavedLevelAmount An reference to an int32 on which we're to track how many Level Sections we've saved.
 	 * @return The serialized data of this SaveState.
 	 */
-	TArray<uint8> SerializeState(int32& OutSavedItemAmount) const;
+	TArray<uint8> SerializeState(int32& OutSavedLevelAmount) const;
 
 	/**
 	 * Function intended to reapply previously serialized data back to be used.
+	 * The Sections are decoded in parallel.
 	 *
 	 * @param ByteArray Data which has been created using Serialize.
-	 * @param InSavedItemAmount Amount of Items which has been saved before.
+	 * @param InSavedLevelAmount Amount of Level Sections which has been saved before.
 	 */
-	void ApplySerializeOnState(const TArray<uint8> ByteArray, const int& InSavedItemAmount);
+	void ApplySerializeOnState(const TArray<uint8> ByteArray, const int& InSavedLevelAmount);
+
+	/**
+	 * Gets the Name under which the Section of the given Level is stored.
+	 *
+	 * @param InLevel Level of which to get the Section Name.
+	 * @return Package Name of the Level, stripped of any PIE Prefix.
+	 */
+	static FName GetLevelSectionName(const ULevel* InLevel);
 
 	/** Gets the Array with References of Classes being saved here. */
 	TArray<UClass*> GetSavedClasses() const;
@@ -120,6 +191,40 @@ private:
 	/** Clears the Internal Variables from it's current references */
 	void ClearContents();
 
+	/**
+	 * Applies the given Section onto the Level, moving, deleting and respawning its Actors.
+	 *
+	 * @param InSection Section to apply.
+	 * @param InLevel Level which the Section belongs to.
+	 * @return List of Actors which have been loaded
+	 */
+	TArray<AActor*> ApplySectionOnLevel(FSavedLevelSection& InSection, ULevel* InLevel);
+
+	/**
+	 * Getting all Actors of the given Classes which reside in a single Level.
+	 *
+	 * @param InLevel Level in which to check for the Actors.
+	 * @param InClassArray Array holding Pointers to Classes to save.
+	 * @return Unsorted TArray of Actors which have been found.
+	 */
+	static TArray<AActor*> GetActorsOfSavedClassesInLevel(ULevel* InLevel, const TArray<UClass*>& InClassArray);
+
+	/**
+	 * Encodes the Objects of a Section into its SectionData.
+	 *
+	 * @param InOutSection Section to encode.
+	 */
+	static void EncodeSection(FSavedLevelSection& InOutSection);
+
+	/**
+	 * Decodes the SectionData of a Section back into its Objects.
+	 *
+	 * @param InOutSection Section to decode.
+	 * @param bLoadIfFindFails Whether Classes not in memory may be loaded, which is only allowed on the GameThread.
+	 * @return false if a Class of the Section could not be resolved.
+	 */
+	static bool DecodeSection(FSavedLevelSection& InOutSection, bool bLoadIfFindFails);
+
 	/**
 	 * Serializes the Input Actor into an ByteArray, to work with Serialize.
 	 *